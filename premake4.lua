@@ -80,6 +80,7 @@ project "task-homie"
     kind "WindowedApp"
     files
         { "src/task-homie/**.h"
+        , "src/task-homie/**.hpp"
         , "src/task-homie/**.cpp"
         , "src/task-homie/**.rc"
         , "src/task-homie-hook/**.hpp"
@@ -0,0 +1,45 @@
+# Reports the memory and handle footprint of every running task-homie.exe,
+# one row per session, followed by per-instance averages. Pass -Csv for
+# machine-readable output. Reading other sessions' GDI/USER counts needs an
+# elevated prompt; those columns are left blank otherwise.
+param ([switch] $Csv)
+
+Add-Type -Namespace TaskHomie -Name Native -MemberDefinition @'
+[DllImport("user32.dll")]
+public static extern uint GetGuiResources(System.IntPtr process, uint flags);
+'@
+
+$GdiObjects = 0
+$UserObjects = 1
+
+function gui_resources ($proc, $flags) {
+    try { [TaskHomie.Native]::GetGuiResources($proc.Handle, $flags) }
+    catch { $null }
+}
+
+$rows = @(Get-Process -Name task-homie -ErrorAction SilentlyContinue | ForEach-Object {
+    [pscustomobject] @{
+        Id = $_.Id
+        Session = $_.SessionId
+        PrivateKB = [int] ($_.PrivateMemorySize64 / 1KB)
+        WorkingSetKB = [int] ($_.WorkingSet64 / 1KB)
+        Handles = $_.HandleCount
+        Gdi = gui_resources $_ $GdiObjects
+        User = gui_resources $_ $UserObjects
+        Threads = $_.Threads.Count
+    }
+})
+
+if ($rows.Count -eq 0) { Write-Error "task-homie is not running"; exit 1 }
+
+$fields = 'PrivateKB', 'WorkingSetKB', 'Handles', 'Gdi', 'User', 'Threads'
+$avg = [ordered] @{ Id = 'avg'; Session = '*' }
+foreach ($field in $fields) {
+    $vals = @($rows | Where-Object { $_.$field -ne $null } | ForEach-Object { $_.$field })
+    $avg[$field] = if ($vals.Count -eq 0) { $null }
+        else { [int] (($vals | Measure-Object -Average).Average) }
+}
+$rows += [pscustomobject] $avg
+
+if ($Csv) { $rows | ConvertTo-Csv -NoTypeInformation }
+else { $rows | Format-Table -AutoSize }
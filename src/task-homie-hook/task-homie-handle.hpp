@@ -0,0 +1,54 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+template <typename mod>
+struct handle_ty final {
+    using t = typename mod::t;
+
+    t handle;
+
+    handle_ty(const t & handle) : handle(handle) { }
+
+    ~handle_ty() { _destroy_(); }
+
+    handle_ty(handle_ty && x) { _move_(x); }
+
+    handle_ty &
+    operator = (handle_ty && x) { _destroy_(); _move_(x); return *this; }
+
+    handle_ty(const handle_ty &) = delete;
+
+    handle_ty &
+    operator = (const handle_ty &) = delete;
+
+    void
+    _move_(handle_ty &x) { handle = x.handle; mod::invalidate(x.handle); }
+
+    void
+    _destroy_() { if (mod::is_valid(handle)) mod::destroy(handle); }
+};
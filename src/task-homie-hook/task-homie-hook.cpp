@@ -27,6 +27,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma runtime_checks("", off)
 
 #include "task-homie-hook.hpp"
+#include "task-homie-slide.hpp"
+#include "task-homie-snapshot.hpp"
 
 #include <atomic>
 
@@ -38,16 +40,80 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma comment(linker, "/EXPORT:task_homie_filter_sync_messages=task_homie_filter_sync_messages")
 #endif
 
-struct state_ty { HWND taskbar; };
+// A snapshot of everything the filter needs to know about the taskbar. Once
+// published, a snapshot is never modified until every reader has let go of it.
+struct state_ty {
+    HWND taskbar;
+    UINT edge;
+    RECT work;
+    bool autohide;
+};
 
 const auto TaskSwitched = WM_USER + 243;
 
-static const state_ty *
-lazy_init_state();
+static HWND
+taskbar_of_current_process() {
+    const auto pid = GetCurrentProcessId();
+    HWND found = nullptr;
+    enum_windows([&] (const HWND wnd) -> BOOL {
+        DWORD wnd_pid;
+        GetWindowThreadProcessId(wnd, &wnd_pid);
+        const auto cls_eq = cls_eq_p(TaskbarCls, wnd);
+        if (wnd_pid == pid && cls_eq) { found = wnd; return FALSE; }
+        return TRUE;
+    });
+    return found;
+}
+
+static std::atomic<UINT> reload_msg;
+
+static void
+init_state(state_ty &state) {
+    reload_msg.store(RegisterWindowMessage(ReloadMsg), std::memory_order_relaxed);
+    state.taskbar = taskbar_of_current_process();
+    state.edge = info_of_taskbar().uEdge;
+    state.work = minfo_of_hwnd(state.taskbar).rcWork;
+    state.autohide = autohide_enabled();
+}
+
+static snapshots_ty<state_ty, 4> snapshots;
+static std::atomic<bool> stale;
+
+static bool
+refresh_p(const UINT message) {
+    const auto reload = reload_msg.load(std::memory_order_relaxed);
+    return
+        message == WM_SETTINGCHANGE ||
+        message == WM_DISPLAYCHANGE ||
+        message == WM_EXITSIZEMOVE ||
+        (reload != 0 && message == reload)
+        ;
+}
+
+static void
+refresh_state(const UINT message) {
+    if (refresh_p(message)) stale.store(true, std::memory_order_release);
+    refresh(snapshots, stale, init_state);
+}
+
+static LONG
+thickness_of(const UINT edge, const RECT &geom) {
+    switch (edge) {
+    case ABE_LEFT:
+    case ABE_RIGHT: return geom.right - geom.left;
+    default: return geom.bottom - geom.top;
+    }
+}
+
+// Messages for a window are only ever delivered on its owning thread, so this
+// needs no locking.
+static slide_ty slide;
 
 template <typename t>
 static void
 filter_message(const t * const info) {
+    refresh_state(info->message);
+
     const auto cond =
         // info->message == WM_WINDOWPOSCHANGED ||
         info->message == WM_MOVE ||
@@ -55,14 +121,24 @@ filter_message(const t * const info) {
         ;
     if (!cond) return;
 
-    const auto state = lazy_init_state();
-    if (state == nullptr) return;
+    const auto pinned = pin(snapshots);
+    if (pinned.handle == nullptr) return;
+    const auto &state = pinned.handle->val;
+    const auto version = pinned.handle->version;
 
-    const auto taskbar = state->taskbar;
+    const auto taskbar = state.taskbar;
     if (taskbar == nullptr) return;
     if (taskbar != info->hwnd) return;
 
-    if (!taskbar_visible_p(taskbar) && autohide_enabled()) hide_taskbar(taskbar);
+    const auto geom = window_geometry(taskbar);
+    if (info->message == WM_MOVE) {
+        track_slide(slide, version, thickness_of(state.edge, geom),
+            taskbar_exposure(state.edge, geom, state.work), GetTickCount());
+    }
+
+    const auto visible = taskbar_visible_p(state.edge, geom, state.work);
+    if (!visible && state.autohide) hide_taskbar(taskbar);
+    else if (hiding_p(slide, version) && state.autohide) conceal_taskbar(taskbar);
     else show_taskbar(taskbar);
 }
 
@@ -73,55 +149,6 @@ passthrough(int code, WPARAM wparam, LPARAM lparam) {
     return CallNextHookEx(nullptr, code, wparam, lparam);
 }
 
-const auto Uninitialized = reinterpret_cast<uintptr_t>(nullptr);
-const auto Initializing = static_cast<uintptr_t>(1);
-
-template <typename t, typename f>
-static t *
-lazy_init_ptr(std::atomic<t *> &init_status, f && init) {
-    const auto raw = init_status.load(std::memory_order_consume);
-    switch (reinterpret_cast<uintptr_t>(raw)) {
-    case Uninitialized: {
-        auto expected = reinterpret_cast<t *>(Uninitialized);
-        const auto exchanged = init_status.compare_exchange_strong(
-            expected, reinterpret_cast<t *>(Initializing),
-            std::memory_order_release, std::memory_order_relaxed);
-        if (!exchanged) return nullptr;
-        else {
-            init_status.store(init(), std::memory_order_release);
-            return raw;
-        }
-    }
-
-    case Initializing: return nullptr;
-
-    default: return raw;
-    }
-}
-
-static HWND
-taskbar_of_current_process() {
-    const auto pid = GetCurrentProcessId();
-    HWND found = nullptr;
-    enum_windows([&] (const HWND wnd) -> BOOL {
-        DWORD wnd_pid;
-        GetWindowThreadProcessId(wnd, &wnd_pid);
-        const auto cls_eq = cls_eq_p(TaskbarCls, wnd);
-        if (wnd_pid == pid && cls_eq) { found = wnd; return FALSE; }
-        return TRUE;
-    });
-    return found;
-}
-
-static std::atomic<state_ty *> init_status;
-static state_ty state;
-
-static const state_ty *
-lazy_init_state() {
-    return lazy_init_ptr(init_status,
-        [] { state.taskbar = taskbar_of_current_process(); return &state; });
-}
-
 extern "C" {
 
 LRESULT CALLBACK
@@ -136,7 +163,10 @@ BOOL WINAPI
 DllMain(HINSTANCE, DWORD reason, LPVOID) {
     switch (reason) {
     case DLL_PROCESS_ATTACH:
-        init_status = reinterpret_cast<state_ty *>(Uninitialized);
+        snapshots.current = nullptr;
+        snapshots.publishing.clear();
+        stale = true;
+        reload_msg = 0;
         return TRUE;
     }
     return TRUE;
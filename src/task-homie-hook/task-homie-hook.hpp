@@ -29,32 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <windows.h>
 #include <shellapi.h>
 
-template <typename mod>
-struct handle_ty final {
-    using t = typename mod::t;
-
-    t handle;
-
-    handle_ty(const t & handle) : handle(handle) { }
-
-    ~handle_ty() { _destroy_(); }
-
-    handle_ty(handle_ty && x) { _move_(x); }
-
-    handle_ty &
-    operator = (handle_ty && x) { _destroy_(); _move_(x); return *this; }
-
-    handle_ty(const handle_ty &) = delete;
-
-    handle_ty &
-    operator = (const handle_ty &) = delete;
-
-    void
-    _move_(handle_ty &x) { handle = x.handle; mod::invalidate(x.handle); }
-
-    void
-    _destroy_() { if (mod::is_valid(handle)) mod::destroy(handle); }
-};
+#include "task-homie-handle.hpp"
 
 struct rgn_ty final {
     using t = HRGN;
@@ -71,6 +46,9 @@ struct rgn_ty final {
 
 const WCHAR TaskbarCls [] = L"Shell_TrayWnd";
 
+// Posted to the taskbar to make the hook rebuild its state snapshot.
+const WCHAR ReloadMsg [] = L"task-homie-reload";
+
 template <typename t>
 static BOOL CALLBACK
 enum_windows_(HWND hwnd, LPARAM env)
@@ -134,17 +112,26 @@ minfo_of_hwnd(const HWND wnd) {
     return info;
 }
 
+// How far the taskbar sticks out past the edge it hides behind.
+static LONG
+taskbar_exposure(const UINT edge, const RECT &taskbar, const RECT &work) {
+    switch (edge) {
+    case ABE_LEFT: return taskbar.right - work.left;
+    case ABE_TOP: return taskbar.bottom - work.top;
+    case ABE_RIGHT: return work.right - taskbar.left;
+    case ABE_BOTTOM: return work.bottom - taskbar.top;
+    default: return 0;
+    }
+}
+
 static bool
-taskbar_visible_p(const HWND taskbar_hwnd) {
-    const auto taskbar_info = info_of_taskbar();
-    const auto taskbar = window_geometry(taskbar_hwnd);
-    const auto monitor = minfo_of_hwnd(taskbar_hwnd);
+taskbar_visible_p(const UINT edge, const RECT &taskbar, const RECT &work) {
     const auto maxdist = 4;
-    switch (taskbar_info.uEdge) {
-    case ABE_LEFT: return taskbar.right > (monitor.rcWork.left + maxdist);
-    case ABE_TOP: return taskbar.bottom > (monitor.rcWork.top + maxdist);
-    case ABE_RIGHT: return taskbar.left < (monitor.rcWork.right - maxdist);
-    case ABE_BOTTOM: return taskbar.top < (monitor.rcWork.bottom - maxdist);
+    switch (edge) {
+    case ABE_LEFT:
+    case ABE_TOP:
+    case ABE_RIGHT:
+    case ABE_BOTTOM: return taskbar_exposure(edge, taskbar, work) > maxdist;
     default: return true;
     }
 }
@@ -153,10 +140,19 @@ static void
 show_taskbar(const HWND taskbar_hwnd) {
     handle_ty<rgn_ty> rgn { CreateRectRgn(0, 0, 0, 0) };
     const auto rgnres = GetWindowRgn(taskbar_hwnd, rgn.handle);
-    if (rgnres == NULLREGION || rgnres == ERROR) return;
+    if (rgnres == ERROR) return;
     SetWindowRgn(taskbar_hwnd, nullptr, true);
 }
 
+// Clips the taskbar away entirely while it's still sliding out of view.
+static void
+conceal_taskbar(const HWND taskbar_hwnd) {
+    handle_ty<rgn_ty> rgn { CreateRectRgn(0, 0, 0, 0) };
+    const auto rgnres = GetWindowRgn(taskbar_hwnd, rgn.handle);
+    if (rgnres == NULLREGION) return;
+    SetWindowRgn(taskbar_hwnd, CreateRectRgn(0, 0, 0, 0), true);
+}
+
 static RECT
 box_from_rgn(const HWND wnd) {
     RECT ret = { 0 };
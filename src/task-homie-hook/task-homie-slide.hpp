@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Slide estimation for the hook, kept free of Win32 so that it can be driven
+// by simulated animations. Exposures and thicknesses are in pixels, times are
+// GetTickCount milliseconds, which only advance every ~15.6ms; at high frame
+// rates several samples share a tick, so speed alone can't tell a slide from
+// a small nudge and a slide must also cover MinSlideDistance.
+
+const unsigned SlideSamples = 3;
+const uint32_t SlideWindow = 100;
+const int32_t MinSlideSpeed = 100;
+const int32_t MinSlideDistance = 6;
+
+// Recent WM_MOVE samples for the taskbar, oldest first, taken against the
+// snapshot with the given version; a new snapshot may have moved the taskbar
+// to another edge or monitor, so it restarts tracking.
+struct slide_ty {
+    unsigned version;
+    int32_t thickness;
+    unsigned count;
+    int32_t exposure[SlideSamples];
+    uint32_t time[SlideSamples];
+};
+
+static void
+track_slide(slide_ty &slide, const unsigned version, const int32_t thickness,
+    const int32_t exposure, const uint32_t now)
+{
+    const auto last = slide.count - 1;
+    const auto restart =
+        slide.count == 0 ||
+        slide.version != version ||
+        slide.thickness != thickness ||
+        now - slide.time[last] > SlideWindow;
+    if (restart) {
+        slide.version = version;
+        slide.thickness = thickness;
+        slide.count = 0;
+    }
+    if (slide.count == SlideSamples) {
+        for (unsigned i = 1; i < SlideSamples; ++i) {
+            slide.exposure[i - 1] = slide.exposure[i];
+            slide.time[i - 1] = slide.time[i];
+        }
+        --slide.count;
+    }
+    slide.exposure[slide.count] = exposure;
+    slide.time[slide.count] = now;
+    ++slide.count;
+}
+
+// Pixels per second the taskbar is retreating behind its edge; negative
+// while it slides into view. Samples that share a tick count as instant.
+static int32_t
+slide_speed(const slide_ty &slide) {
+    if (slide.count < 2) return 0;
+    const auto last = slide.count - 1;
+    const auto dist = slide.exposure[0] - slide.exposure[last];
+    const auto dt = slide.time[last] - slide.time[0];
+    if (dt == 0) return dist * 1000;
+    return static_cast<int32_t>(dist * 1000 / static_cast<int32_t>(dt));
+}
+
+// A hide is certain once every recent step moved the taskbar further behind
+// its edge, over a distance and at a speed no user drag or layout nudge would
+// produce. Any step back towards the screen cancels it.
+static bool
+hiding_p(const slide_ty &slide, const unsigned version) {
+    if (slide.version != version || slide.count < SlideSamples) return false;
+    for (unsigned i = 1; i < slide.count; ++i) {
+        if (slide.exposure[i] >= slide.exposure[i - 1]) return false;
+    }
+    if (slide.exposure[0] - slide.exposure[slide.count - 1] < MinSlideDistance) return false;
+    return slide_speed(slide) >= MinSlideSpeed;
+}
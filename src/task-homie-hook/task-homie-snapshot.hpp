@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+
+#include "task-homie-handle.hpp"
+
+// Readers pin the current slot by bumping its reader count and then checking
+// that it is still current; one publisher at a time fills a slot that is
+// neither current nor pinned and swaps it in. Readers never block, and a
+// publisher that can't find a free slot (or loses the race to publish) gives
+// up.
+template <typename t, size_t Slots>
+struct snapshots_ty final {
+    struct slot_ty final {
+        std::atomic<unsigned> readers;
+        unsigned version;
+        t val;
+    };
+
+    slot_ty slots[Slots];
+    std::atomic<slot_ty *> current;
+    std::atomic_flag publishing;
+    unsigned version;
+};
+
+template <typename slot>
+struct pin_ty final {
+    using t = slot *;
+
+    static bool
+    is_valid(t handle) { return handle != nullptr; }
+
+    static void
+    invalidate(t &handle) { handle = nullptr; }
+
+    static void
+    destroy(t handle) { handle->readers.fetch_sub(1, std::memory_order_release); }
+};
+
+template <typename t, size_t Slots>
+static handle_ty<pin_ty<typename snapshots_ty<t, Slots>::slot_ty>>
+pin(snapshots_ty<t, Slots> &snapshots) { for (;;) {
+    const auto slot = snapshots.current.load(std::memory_order_seq_cst);
+    if (slot == nullptr) return { nullptr };
+    slot->readers.fetch_add(1, std::memory_order_seq_cst);
+    if (snapshots.current.load(std::memory_order_seq_cst) == slot) return { slot };
+    slot->readers.fetch_sub(1, std::memory_order_release);
+}; }
+
+template <typename t, size_t Slots, typename f>
+static bool
+publish(snapshots_ty<t, Slots> &snapshots, f && init) {
+    if (snapshots.publishing.test_and_set(std::memory_order_acquire)) return false;
+    const auto cur = snapshots.current.load(std::memory_order_relaxed);
+    typename snapshots_ty<t, Slots>::slot_ty *dst = nullptr;
+    for (auto &slot : snapshots.slots) {
+        if (&slot == cur) continue;
+        if (slot.readers.load(std::memory_order_seq_cst) != 0) continue;
+        dst = &slot;
+        break;
+    }
+    if (dst != nullptr) {
+        init(dst->val);
+        dst->version = ++snapshots.version;
+        snapshots.current.store(dst, std::memory_order_seq_cst);
+    }
+    snapshots.publishing.clear(std::memory_order_release);
+    return dst != nullptr;
+}
+
+// Publishes a new snapshot if `stale` was set, from whichever thread gets
+// here first. A thread that takes the request but can't publish sets `stale`
+// again, so the request is retried on a later call instead of being lost.
+template <typename t, size_t Slots, typename f>
+static void
+refresh(snapshots_ty<t, Slots> &snapshots, std::atomic<bool> &stale, f && init) {
+    if (!stale.load(std::memory_order_relaxed)) return;
+    if (!stale.exchange(false, std::memory_order_acquire)) return;
+    if (!publish(snapshots, init)) stale.store(true, std::memory_order_release);
+}
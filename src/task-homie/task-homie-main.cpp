@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <tuple>
 
 #include "resource.h"
+#include "task-homie-probe.hpp"
 
 #pragma warning(disable : 4510) // constructor could not be generated
 #pragma warning(disable : 4610) // [...] can never be instantiated
@@ -58,6 +59,44 @@ const auto QuitRestart = WM_APP + 1;
 
 const auto MenuExit = 0;
 
+// Commands forwarded to a running instance as WM_COPYDATA, tagged with
+// CopyDataTag and carrying a single DWORD. wParam may hold a window that
+// replies are sent back to as WM_COPYDATA tagged with ReplyDataTag.
+namespace cmd {
+const DWORD None = 0;
+const DWORD Show = 1;
+const DWORD Hide = 2;
+const DWORD Suspend = 3;
+const DWORD Resume = 4;
+const DWORD ReloadPolicy = 5;
+const DWORD DumpStats = 6;
+const DWORD Exit = 7;
+const DWORD Unknown = ~static_cast<DWORD>(0);
+}
+
+const ULONG_PTR CopyDataTag = 0x74686331;
+const ULONG_PTR ReplyDataTag = 0x74686332;
+
+struct command_name_ty { const WCHAR *name; DWORD id; };
+
+const command_name_ty CommandNames [] =
+    { { L"show", cmd::Show }
+    , { L"hide", cmd::Hide }
+    , { L"suspend", cmd::Suspend }
+    , { L"resume", cmd::Resume }
+    , { L"reload-policy", cmd::ReloadPolicy }
+    , { L"dump-stats", cmd::DumpStats }
+    , { L"exit", cmd::Exit }
+    };
+
+const WCHAR * const LaunchArgs [] = { L"lean", L"suspended", L"probe" };
+
+const WCHAR SingleProcessTag [] =
+    L"task-homie-single-process-11cc0e01-31bf-426f-b2fa-2e52e9e426f8";
+
+const WCHAR DummyCls [] = L"static";
+const WCHAR DummyTitle [] = L"task-homie-dummy";
+
 struct hook_ty final {
     using t = HHOOK;
 
@@ -71,6 +110,45 @@ struct hook_ty final {
     destroy(t handle) { UnhookWindowsHookEx(handle); }
 };
 
+struct menu_ty final {
+    using t = HMENU;
+
+    static bool
+    is_valid(t handle) { return handle != nullptr; }
+
+    static void
+    invalidate(t &handle) { handle = nullptr; }
+
+    static void
+    destroy(t handle) { DestroyMenu(handle); }
+};
+
+struct heap_ty final {
+    using t = WCHAR *;
+
+    static bool
+    is_valid(t handle) { return handle != nullptr; }
+
+    static void
+    invalidate(t &handle) { handle = nullptr; }
+
+    static void
+    destroy(t handle) { HeapFree(GetProcessHeap(), 0, handle); }
+};
+
+struct local_ty final {
+    using t = LPWSTR *;
+
+    static bool
+    is_valid(t handle) { return handle != nullptr; }
+
+    static void
+    invalidate(t &handle) { handle = nullptr; }
+
+    static void
+    destroy(t handle) { LocalFree(handle); }
+};
+
 struct trayinfo_ty final { bool valid; NOTIFYICONDATA data; };
 
 struct tray_ty final {
@@ -90,9 +168,15 @@ using hook_handle_ty = handle_ty<hook_ty>;
 
 using tray_handle_ty = handle_ty<tray_ty>;
 
+using menu_handle_ty = handle_ty<menu_ty>;
+
+using wstr_handle_ty = handle_ty<heap_ty>;
+
 using hooks_ty = std::tuple<hook_handle_ty, hook_handle_ty>;
 
-struct exit_ty { int code; bool should_restart; };
+struct launch_ty { bool lean; bool suspended; };
+
+struct exit_ty { int code; bool should_restart; launch_ty relaunch; };
 
 int
 failwith(const WCHAR * const reason) {
@@ -102,6 +186,14 @@ failwith(const WCHAR * const reason) {
     return 0;
 }
 
+static void
+write_out(const char * const str) {
+    const auto out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD written;
+    if (out == nullptr || out == INVALID_HANDLE_VALUE) OutputDebugStringA(str);
+    else WriteFile(out, str, lstrlenA(str), &written, nullptr);
+}
+
 template <size_t DstSz, size_t SrcSz>
 static void
 copy_wstr(WCHAR (&dst)[DstSz], const WCHAR (&src)[SrcSz]) {
@@ -126,7 +218,7 @@ load_icon() {
     const auto size = GetSystemMetrics(SM_CXSMICON);
     const auto icon = reinterpret_cast<HICON>(LoadImage(
         mod, MAKEINTRESOURCE(IDI_ICON1), IMAGE_ICON, size, size,
-        LR_DEFAULTCOLOR));
+        LR_DEFAULTCOLOR | LR_SHARED));
     return icon;
 }
 
@@ -147,7 +239,9 @@ mk_notify_icon_data(const UINT id, const HWND wnd, const HICON icon) {
 }
 
 static tray_handle_ty
-mk_systray_icon(const UINT id, const HWND wnd, const HICON icon) {
+mk_systray_icon(const UINT id, const HWND wnd) {
+    const auto icon = load_icon();
+    if (icon == nullptr) { failwith(L"load_icon"); return { trayinfo_ty() }; }
     auto data = mk_notify_icon_data(id, wnd, icon);
     if (!Shell_NotifyIcon(NIM_ADD, &data.data)) data.valid = false;
     else if (!Shell_NotifyIcon(NIM_SETVERSION, &data.data)) data.valid = false;
@@ -162,9 +256,16 @@ mk_hooks(const HWND wnd, const HINSTANCE dylib, const HOOKPROC sync, const HOOKP
     return hooks_ty { mk(WH_CALLWNDPROCRET, sync), mk(WH_GETMESSAGE, async) };
 }
 
+static bool
+hooks_valid_p(const hooks_ty &hooks) {
+    return
+        hook_ty::is_valid(std::get<0>(hooks).handle) &&
+        hook_ty::is_valid(std::get<1>(hooks).handle);
+}
+
 static HWND
 mk_dummy_window() {
-    return CreateWindow(L"static", L"task-homie-dummy", 0,
+    return CreateWindow(DummyCls, DummyTitle, 0,
         0, 0, 1, 1,
         nullptr, nullptr, nullptr, nullptr);
 }
@@ -178,24 +279,111 @@ mk_context_menu() {
 
 template <typename f1, typename f2>
 struct state_ty final {
-    const HMENU menu;
     const HWND wnd;
     hooks_ty hooks;
     tray_handle_ty tray;
     const UINT taskbar_created_msg;
+    const UINT reload_msg;
     const f1 & remake_hooks;
     const f2 & remake_tray;
     const bool restart_on_new_taskbar;
+    const DWORD started;
+    bool show_tray;
+    bool suspended;
+    UINT commands;
 };
 
+static bool
+reply_to(const HWND reply_wnd, const HWND from, const char * const text) {
+    if (reply_wnd == nullptr) { OutputDebugStringA(text); return true; }
+    COPYDATASTRUCT data;
+    data.dwData = ReplyDataTag;
+    data.cbData = lstrlenA(text);
+    data.lpData = const_cast<char *>(text);
+    DWORD_PTR result = FALSE;
+    const auto sent = SendMessageTimeout(reply_wnd, WM_COPYDATA,
+        reinterpret_cast<WPARAM>(from), reinterpret_cast<LPARAM>(&data),
+        SMTO_ABORTIFHUNG, 5000, &result);
+    return sent != 0 && result == TRUE;
+}
+
+static bool
+dump_stats(const HWND reply_wnd, const HWND from, const DWORD uptime,
+    const bool show_tray, const bool suspended, const UINT commands)
+{
+    const auto proc = GetCurrentProcess();
+    DWORD handles = 0;
+    GetProcessHandleCount(proc, &handles);
+    char buf[256];
+    wsprintfA(buf,
+        "{\"uptime_ms\":%lu,\"tray\":%d,\"suspended\":%d,\"commands\":%u,"
+        "\"handles\":%lu,\"gdi\":%lu,\"user\":%lu}\r\n",
+        uptime, show_tray ? 1 : 0, suspended ? 1 : 0, commands,
+        handles, GetGuiResources(proc, GR_GDIOBJECTS),
+        GetGuiResources(proc, GR_USEROBJECTS));
+    return reply_to(reply_wnd, from, buf);
+}
+
+// Reinstalls the hooks and makes the hook rebuild its snapshot, which may
+// be stale if the hook DLL stayed mapped in explorer while unhooked.
+template <typename t>
+static bool
+reload_hooks(t &state) {
+    state.hooks = state.remake_hooks();
+    if (!hooks_valid_p(state.hooks)) return false;
+    return PostMessage(find_taskbar(), state.reload_msg, 0, 0) != 0;
+}
+
+template <typename t>
+static bool
+run_command(t &state, const DWORD command, const HWND reply_wnd) {
+    switch (command) {
+    case cmd::Show:
+        state.show_tray = true;
+        if (!tray_ty::is_valid(state.tray.handle)) state.tray = state.remake_tray();
+        return tray_ty::is_valid(state.tray.handle);
+
+    case cmd::Hide:
+        state.show_tray = false;
+        state.tray = tray_handle_ty { trayinfo_ty() };
+        return true;
+
+    case cmd::Suspend:
+        state.suspended = true;
+        state.hooks = hooks_ty { hook_handle_ty { nullptr }, hook_handle_ty { nullptr } };
+        show_taskbar(find_taskbar());
+        return true;
+
+    case cmd::Resume:
+        if (!state.suspended) return hooks_valid_p(state.hooks);
+        state.suspended = false;
+        return reload_hooks(state);
+
+    case cmd::ReloadPolicy:
+        // Nothing is hooked to refresh; resume reloads once it reinstalls.
+        if (state.suspended) return true;
+        return reload_hooks(state);
+
+    case cmd::DumpStats:
+        return dump_stats(reply_wnd, state.wnd, GetTickCount() - state.started,
+            state.show_tray, state.suspended, state.commands);
+
+    case cmd::Exit: PostQuitMessage(0); return true;
+
+    default: return false;
+    }
+}
+
 template <typename t>
 static LRESULT CALLBACK
 wnd_proc(const HWND wnd, const UINT msg, const WPARAM wparam, const LPARAM lparam) {
     auto &state = *reinterpret_cast<t *>(GetWindowLongPtr(wnd, GWLP_USERDATA));
     const auto show_context_menu = [&] {
+        const menu_handle_ty menu { mk_context_menu() };
+        if (menu.handle == nullptr) return;
         POINT pt;
         GetCursorPos(&pt);
-        TrackPopupMenu(state.menu, TPM_RIGHTBUTTON, pt.x, pt.y,
+        TrackPopupMenu(menu.handle, TPM_RIGHTBUTTON, pt.x, pt.y,
             0, state.wnd, nullptr);
     };
 
@@ -207,6 +395,15 @@ wnd_proc(const HWND wnd, const UINT msg, const WPARAM wparam, const LPARAM lpara
     }
     break;
 
+    case WM_COPYDATA: {
+        const auto data = reinterpret_cast<const COPYDATASTRUCT *>(lparam);
+        if (data->dwData != CopyDataTag || data->cbData != sizeof(DWORD)) break;
+        const auto handled = run_command(state, *static_cast<const DWORD *>(data->lpData),
+            reinterpret_cast<HWND>(wparam));
+        if (handled) ++state.commands;
+        return handled ? TRUE : FALSE;
+    }
+
     case msg::TrayIcon:
         switch (LOWORD(lparam)) {
         case WM_RBUTTONUP:
@@ -222,8 +419,8 @@ wnd_proc(const HWND wnd, const UINT msg, const WPARAM wparam, const LPARAM lpara
             if (state.restart_on_new_taskbar) {
                 PostMessage(wnd, msg::QuitRestart, 0, 0);
             } else {
-                state.tray = state.remake_tray();
-                state.hooks = state.remake_hooks();
+                if (state.show_tray) state.tray = state.remake_tray();
+                if (!state.suspended) state.hooks = state.remake_hooks();
             }
         }
         break;
@@ -245,34 +442,67 @@ loop() { for (;;) {
     DispatchMessage(&msg);
 }; }
 
-template <size_t DstSz, size_t SrcSz>
-bool
-wstr_append(WCHAR (&dst)[DstSz], const WCHAR (&src)[SrcSz]) {
-    const auto len = lstrlen(dst);
-    if ((DstSz - len) < SrcSz) return false;
-    if (lstrcat(dst, src) == nullptr) { dst[0] = 0; return false; }
-    return true;
+static wstr_handle_ty
+alloc_wstr(const size_t len) {
+    return { static_cast<WCHAR *>(HeapAlloc(GetProcessHeap(), 0, len * sizeof(WCHAR))) };
 }
 
-template <size_t Sz>
-static bool
-empty_path(WCHAR (&path)[Sz]) { path[0] = 0; return false; };
+// Sized to fit the module path, with room for `extra` more characters.
+static wstr_handle_ty
+get_exe_path(const DWORD extra) {
+    const DWORD MaxPath = 32768;
+    for (DWORD sz = MAX_PATH;; sz = sz < MaxPath / 2 ? sz * 2 : MaxPath) {
+        auto path = alloc_wstr(sz + extra);
+        if (path.handle == nullptr) break;
+        const auto end = GetModuleFileName(nullptr, path.handle, sz);
+        if (end == 0) break;
+        if (end < sz) return path;
+        if (sz == MaxPath) break;
+    }
+    return { nullptr };
+}
+
+const WCHAR HookDll [] = L"\\task-homie-hook.dll";
+
+static wstr_handle_ty
+get_hook_path() {
+    auto path = get_exe_path(sizeof(HookDll) / sizeof(WCHAR));
+    if (path.handle == nullptr) return path;
+    PathRemoveFileSpec(path.handle);
+    lstrcat(path.handle, HookDll);
+    return path;
+}
 
-template <size_t Sz>
+template <typename f>
 static bool
-append_hook_path(WCHAR (&path)[Sz]) {
-    PathRemoveFileSpec(path);
-    if (!wstr_append(path, L"\\task-homie-hook.dll")) return empty_path(path);
-    return true;
+any_arg(f && pred) {
+    int argc = 0;
+    const handle_ty<local_ty> argv { CommandLineToArgvW(GetCommandLine(), &argc) };
+    if (argv.handle == nullptr) return false;
+    for (int i = 1; i < argc; ++i) {
+        if (pred(argv.handle[i])) return true;
+    }
+    return false;
 }
 
-template <size_t Sz>
 static bool
-get_exe_path(WCHAR (&path)[Sz]) {
-    path[Sz - 1] = 0;
-    const auto end = GetModuleFileName(GetModuleHandle(nullptr), path, Sz - 1);
-    if (end == 0) return empty_path(path);
-    return true;
+has_arg(const WCHAR * const arg)
+{ return any_arg([&] (const WCHAR * const x) { return lstrcmpi(x, arg) == 0; }); }
+
+static DWORD
+command_of_args() {
+    auto ret = cmd::None;
+    any_arg([&] (const WCHAR * const x) {
+        for (const auto launch_arg : LaunchArgs) {
+            if (lstrcmpi(x, launch_arg) == 0) return false;
+        }
+        ret = cmd::Unknown;
+        for (const auto &command : CommandNames) {
+            if (lstrcmpi(x, command.name) == 0) { ret = command.id; break; }
+        }
+        return true;
+    });
+    return ret;
 }
 
 template <typename f1, typename f2>
@@ -299,6 +529,65 @@ init_wndproc(const HWND wnd, void * const state, const WNDPROC wndproc) {
     return true;
 }
 
+struct window_ty final {
+    using t = HWND;
+
+    static bool
+    is_valid(t handle) { return handle != nullptr; }
+
+    static void
+    invalidate(t &handle) { handle = nullptr; }
+
+    static void
+    destroy(t handle) { DestroyWindow(handle); }
+};
+
+struct reply_ty final { bool received; char text[512]; };
+
+static LRESULT CALLBACK
+reply_wnd_proc(const HWND wnd, const UINT msg, const WPARAM wparam, const LPARAM lparam) {
+    if (msg != WM_COPYDATA) return DefWindowProc(wnd, msg, wparam, lparam);
+    auto &reply = *reinterpret_cast<reply_ty *>(GetWindowLongPtr(wnd, GWLP_USERDATA));
+    const auto data = reinterpret_cast<const COPYDATASTRUCT *>(lparam);
+    if (data->dwData != ReplyDataTag) return FALSE;
+    const DWORD cap = sizeof(reply.text) - 1;
+    const auto len = data->cbData < cap ? data->cbData : cap;
+    for (DWORD i = 0; i < len; ++i) reply.text[i] = static_cast<const char *>(data->lpData)[i];
+    reply.text[len] = 0;
+    reply.received = true;
+    return TRUE;
+}
+
+// Sends `command` to the running instance along with a message-only window
+// for it to reply to, and copies any reply to stdout.
+static int
+send_command(const DWORD command) {
+    const auto wnd = FindWindow(DummyCls, DummyTitle);
+    if (wnd == nullptr) { failwith(L"no running instance"); return 1; }
+
+    reply_ty reply = { false, { 0 } };
+    const handle_ty<window_ty> reply_wnd { CreateWindow(DummyCls, nullptr, 0,
+        0, 0, 0, 0, HWND_MESSAGE, nullptr, nullptr, nullptr) };
+    if (reply_wnd.handle == nullptr) { failwith(L"mk_reply_window"); return 1; }
+    if (!init_wndproc(reply_wnd.handle, &reply, &reply_wnd_proc)) {
+        failwith(L"init_wndproc reply");
+        return 1;
+    }
+
+    auto payload = command;
+    COPYDATASTRUCT data;
+    data.dwData = CopyDataTag;
+    data.cbData = sizeof(payload);
+    data.lpData = &payload;
+    DWORD_PTR result = FALSE;
+    const auto sent = SendMessageTimeout(wnd, WM_COPYDATA,
+        reinterpret_cast<WPARAM>(reply_wnd.handle), reinterpret_cast<LPARAM>(&data),
+        SMTO_ABORTIFHUNG, 5000, &result);
+    if (sent == 0) { failwith(L"SendMessageTimeout WM_COPYDATA"); return 1; }
+    if (reply.received) write_out(reply.text);
+    return result == TRUE ? 0 : 1;
+}
+
 static void
 set_dpi_aware() {
     const auto lib = LoadLibrary(L"user32.dll");
@@ -309,54 +598,76 @@ set_dpi_aware() {
     FreeLibrary(lib);
 }
 
-static exit_ty
-run_(const WCHAR * const dll_path) {
-    const auto fail = [] (const WCHAR *msg)
-        { return exit_ty { failwith(msg), false }; };
-    set_dpi_aware();
+static HMODULE
+load_hook() {
+    const auto dll_path = get_hook_path();
+    if (dll_path.handle == nullptr) return nullptr;
+    return LoadLibrary(dll_path.handle);
+}
+
+struct hook_lib_ty { HMODULE lib; HOOKPROC sync; HOOKPROC async; const WCHAR *error; };
+
+static hook_lib_ty
+load_hook_lib() {
+    hook_lib_ty ret = { nullptr, nullptr, nullptr, nullptr };
+    const auto fail = [&] (const WCHAR *msg) { ret.error = msg; return ret; };
 
-    const auto lib = LoadLibrary(dll_path);
-    if (lib == nullptr) return fail(L"LoadLibrary");
+    ret.lib = load_hook();
+    if (ret.lib == nullptr) return fail(L"LoadLibrary");
 
-    const auto sync_fun = GetProcAddress(lib, "task_homie_filter_sync_messages");
+    const auto sync_fun = GetProcAddress(ret.lib, "task_homie_filter_sync_messages");
     if (sync_fun == nullptr) return fail(L"GetProcAddress task_homie_filter_sync_messages");
 
-    const auto async_fun = GetProcAddress(lib, "task_homie_filter_async_messages");
+    const auto async_fun = GetProcAddress(ret.lib, "task_homie_filter_async_messages");
     if (async_fun == nullptr) return fail(L"GetProcAddress task_homie_filter_async_messages");
 
+    ret.sync = reinterpret_cast<HOOKPROC>(sync_fun);
+    ret.async = reinterpret_cast<HOOKPROC>(async_fun);
+    return ret;
+}
+
+static exit_ty
+run_(const launch_ty launch) {
+    const auto fail = [] (const WCHAR *msg)
+        { return exit_ty { failwith(msg), false }; };
+    set_dpi_aware();
+
+    const auto hook = load_hook_lib();
+    if (hook.error != nullptr) return fail(hook.error);
+
     const auto taskbar_created_msg = RegisterWindowMessage(L"TaskbarCreated");
     if (taskbar_created_msg == 0) return fail(L"RegisterWindowMessage TaskbarCreated");
 
-    const auto icon = load_icon();
-    if (icon == nullptr) return fail(L"load_icon");
+    const auto reload_msg = RegisterWindowMessage(ReloadMsg);
+    if (reload_msg == 0) return fail(L"RegisterWindowMessage task-homie-reload");
 
     const auto dummy_wnd = mk_dummy_window();
     if (dummy_wnd == nullptr) return fail(L"mk_dummy_window");
 
-    const auto menu = mk_context_menu();
-    if (menu == nullptr) return fail(L"mk_context_menu");
-
     UINT id = 0;
     const auto remake_tray = [&] {
         ++id;
-        return mk_systray_icon(id, dummy_wnd, icon);
+        return mk_systray_icon(id, dummy_wnd);
     };
 
-    const auto remake_hooks = [&] {
-        return mk_hooks(find_taskbar(), lib,
-            reinterpret_cast<HOOKPROC>(sync_fun),
-            reinterpret_cast<HOOKPROC>(async_fun));
-    };
+    const auto remake_hooks = [&]
+        { return mk_hooks(find_taskbar(), hook.lib, hook.sync, hook.async); };
 
     state_ty<decltype(remake_hooks), decltype(remake_tray)> state
-        { menu
-        , dummy_wnd
-        , remake_hooks()
-        , remake_tray()
+        { dummy_wnd
+        , launch.suspended
+            ? hooks_ty { hook_handle_ty { nullptr }, hook_handle_ty { nullptr } }
+            : remake_hooks()
+        , launch.lean ? tray_handle_ty { trayinfo_ty() } : remake_tray()
         , taskbar_created_msg
+        , reload_msg
         , remake_hooks
         , remake_tray
         , true
+        , GetTickCount()
+        , !launch.lean
+        , launch.suspended
+        , 0
         };
 
     if (!init_wndproc(dummy_wnd, &state, &wnd_proc<decltype(state)>)) {
@@ -364,35 +675,158 @@ run_(const WCHAR * const dll_path) {
     }
 
     show_taskbar(find_taskbar());
-    const auto ret = loop();
+    auto ret = loop();
     show_taskbar(find_taskbar());
+    ret.relaunch = launch_ty { !state.show_tray, state.suspended };
     return ret;
 }
 
+struct qpc_clock_ty final {
+    int freq;
+
+    uint64_t
+    now() const {
+        LARGE_INTEGER ret;
+        QueryPerformanceCounter(&ret);
+        return static_cast<uint64_t>(ret.QuadPart);
+    }
+
+    void
+    sleep_until(const uint64_t deadline) const {
+        const auto cur = now();
+        if (deadline <= cur) return;
+        Sleep(MulDiv(static_cast<int>(deadline - cur), 1000, freq));
+    }
+
+    uint64_t
+    of_ms(const int ms) const { return static_cast<uint64_t>(MulDiv(ms, freq, 1000)); }
+
+    int
+    to_us(const uint64_t ticks) const
+    { return MulDiv(static_cast<int>(ticks), 1000000, freq); }
+};
+
+static void
+write_summary(const char * const name, const qpc_clock_ty &clock,
+    const probe_summary_ty &summary)
+{
+    char buf[256];
+    wsprintfA(buf,
+        "\"%s\":{\"count\":%u,\"timeouts\":%u,\"p50_us\":%d,\"p90_us\":%d,"
+        "\"p99_us\":%d,\"max_us\":%d},",
+        name, summary.count, summary.timeouts, clock.to_us(summary.p50),
+        clock.to_us(summary.p90), clock.to_us(summary.p99), clock.to_us(summary.max));
+    write_out(buf);
+}
+
+// Times WM_NULL round trips to the taskbar thread with and without the hooks
+// installed, and writes the results to stdout as a single JSON object.
+static int
+probe() {
+    const auto fail = [] (const WCHAR *msg) { failwith(msg); return 1; };
+    const auto PingTimeoutMs = 1000;
+    const auto IntervalMs = 20;
+
+    LARGE_INTEGER freq;
+    if (!QueryPerformanceFrequency(&freq)) return fail(L"QueryPerformanceFrequency");
+    if (freq.QuadPart <= 0 || freq.QuadPart > 0x7fffffff) {
+        return fail(L"QueryPerformanceFrequency out of range");
+    }
+    const qpc_clock_ty clock { static_cast<int>(freq.QuadPart) };
+
+    const auto hook = load_hook_lib();
+    if (hook.error != nullptr) return fail(hook.error);
+
+    const auto taskbar = find_taskbar();
+    if (taskbar == nullptr) return fail(L"find_taskbar");
+
+    hooks_ty hooks { hook_handle_ty { nullptr }, hook_handle_ty { nullptr } };
+    const auto set_hooked = [&] (const bool hooked) {
+        if (!hooked) {
+            hooks = hooks_ty { hook_handle_ty { nullptr }, hook_handle_ty { nullptr } };
+            show_taskbar(taskbar);
+            return true;
+        }
+        hooks = mk_hooks(taskbar, hook.lib, hook.sync, hook.async);
+        return hooks_valid_p(hooks);
+    };
+    const auto ping = [&] {
+        DWORD_PTR result;
+        return SendMessageTimeout(taskbar, WM_NULL, 0, 0,
+            SMTO_NORMAL | SMTO_ABORTIFHUNG, PingTimeoutMs, &result) != 0;
+    };
+
+    const probe_config_ty config =
+        { 8
+        , 100
+        , clock.of_ms(IntervalMs)
+        , clock.of_ms(500)
+        };
+    static probe_samples_ty hooked;
+    static probe_samples_ty unhooked;
+    const auto ok = run_probe(config, clock, ping, set_hooked, hooked, unhooked);
+    set_hooked(false);
+    if (!ok) return fail(L"mk_hooks");
+
+    const auto on = summarize_probe(hooked);
+    const auto off = summarize_probe(unhooked);
+    const auto delta = [&] (const uint64_t x, const uint64_t y)
+        { return clock.to_us(x) - clock.to_us(y); };
+
+    char buf[256];
+    wsprintfA(buf, "{\"phases\":%u,\"samples_per_phase\":%u,\"interval_ms\":%d,",
+        config.phases, config.samples, IntervalMs);
+    write_out(buf);
+    write_summary("hooked", clock, on);
+    write_summary("unhooked", clock, off);
+    wsprintfA(buf,
+        "\"delta_us\":{\"p50\":%d,\"p90\":%d,\"p99\":%d,\"max\":%d}}\r\n",
+        delta(on.p50, off.p50), delta(on.p90, off.p90),
+        delta(on.p99, off.p99), delta(on.max, off.max));
+    write_out(buf);
+    return 0;
+}
+
+// Relaunches with launch arguments that reproduce the tray and suspend state
+// the exiting instance ended up in, which may differ from how it was started.
 static void
-start_process(const WCHAR * const exe_path) {
+start_process(const launch_ty launch) {
+    const auto exe_path = get_exe_path(0);
+    if (exe_path.handle == nullptr) { failwith(L"get_exe_path"); return; }
+    const WCHAR Lean [] = L" lean";
+    const WCHAR Suspended [] = L" suspended";
+    const auto args = alloc_wstr(lstrlen(exe_path.handle) + 3
+        + sizeof(Lean) / sizeof(WCHAR) + sizeof(Suspended) / sizeof(WCHAR));
+    if (args.handle == nullptr) { failwith(L"alloc_wstr"); return; }
+    lstrcpy(args.handle, L"\"");
+    lstrcat(args.handle, exe_path.handle);
+    lstrcat(args.handle, L"\"");
+    if (launch.lean) lstrcat(args.handle, Lean);
+    if (launch.suspended) lstrcat(args.handle, Suspended);
     PROCESS_INFORMATION process_info = { 0 };
     STARTUPINFO startup_info = { 0 };
     startup_info.cb = sizeof(STARTUPINFO);
-    CreateProcess(exe_path, nullptr, nullptr, nullptr, FALSE, 0,
+    CreateProcess(exe_path.handle, args.handle, nullptr, nullptr, FALSE, 0,
         nullptr, nullptr, &startup_info, &process_info);
 }
 
-const auto MaxPath = 65536;
-static WCHAR dll_path[MaxPath] = { 0 };
-static WCHAR exe_path[MaxPath] = { 0 };
-
 static int
 run() {
-    if (!get_exe_path(dll_path)) return failwith(L"get_exe_path dll_path");
-    if (!append_hook_path(dll_path)) return failwith(L"append_hook_path dll_path");
-    if (!get_exe_path(exe_path)) return failwith(L"get_exe_path exe_path");
+    const auto command = command_of_args();
+    if (command == cmd::Unknown) { failwith(L"unknown command"); return 1; }
+    if (command != cmd::None) return send_command(command);
+
+    if (has_arg(L"probe")) {
+        return only_once(SingleProcessTag,
+            [] { failwith(L"probe needs task-homie to not be running"); return 1; },
+            [] { return probe(); });
+    }
 
-    const auto ret = only_once(
-        L"task-homie-single-process-11cc0e01-31bf-426f-b2fa-2e52e9e426f8",
+    const launch_ty launch = { has_arg(L"lean"), has_arg(L"suspended") };
+    const auto ret = only_once(SingleProcessTag,
         [] { return exit_ty { 0, false }; },
-        [] { return run_(dll_path); });
-    if (ret.should_restart) { start_process(exe_path); }
+        [&] { return run_(launch); });
+    if (ret.should_restart) { start_process(ret.relaunch); }
     return ret.code;
 }
 
@@ -0,0 +1,119 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// Probe scheduling and statistics, kept free of Win32 so that they can be
+// driven by a fake clock. Times are in clock ticks and are only ever added,
+// subtracted and compared: 64-bit multiplies and divides would need CRT
+// helpers on x86.
+
+const unsigned ProbeMaxSamples = 512;
+
+struct probe_config_ty {
+    unsigned phases;
+    unsigned samples;
+    uint64_t interval;
+    uint64_t settle;
+};
+
+struct probe_samples_ty {
+    unsigned count;
+    unsigned timeouts;
+    uint64_t latency[ProbeMaxSamples];
+};
+
+struct probe_summary_ty {
+    unsigned count;
+    unsigned timeouts;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t max;
+};
+
+// Alternates between hooked and unhooked phases, starting hooked. Each phase
+// waits `settle` ticks after toggling the hooks and then pings once every
+// `interval` ticks; pings that overrun their slot push the rest of the phase
+// back rather than being fired in a burst.
+template <typename clock_ty, typename f1, typename f2>
+static bool
+run_probe(const probe_config_ty &config, clock_ty &clock, f1 && ping,
+    f2 && set_hooked, probe_samples_ty &hooked, probe_samples_ty &unhooked)
+{
+    hooked.count = hooked.timeouts = 0;
+    unhooked.count = unhooked.timeouts = 0;
+    for (unsigned phase = 0; phase < config.phases; ++phase) {
+        const auto hooks_on = phase % 2 == 0;
+        auto &samples = hooks_on ? hooked : unhooked;
+        if (!set_hooked(hooks_on)) return false;
+        auto deadline = clock.now() + config.settle;
+        for (unsigned i = 0; i < config.samples; ++i) {
+            clock.sleep_until(deadline);
+            const auto start = clock.now();
+            const auto ok = ping();
+            const auto end = clock.now();
+            if (!ok) ++samples.timeouts;
+            else if (samples.count < ProbeMaxSamples) {
+                samples.latency[samples.count++] = end - start;
+            }
+            deadline += config.interval;
+            if (deadline < end) deadline = end;
+        }
+    }
+    return true;
+}
+
+static uint64_t
+nearest_rank(const probe_samples_ty &sorted, const unsigned pct) {
+    if (sorted.count == 0) return 0;
+    auto rank = (pct * sorted.count + 99) / 100;
+    if (rank == 0) rank = 1;
+    return sorted.latency[rank - 1];
+}
+
+// Sorts `samples` in place.
+static probe_summary_ty
+summarize_probe(probe_samples_ty &samples) {
+    for (unsigned i = 1; i < samples.count; ++i) {
+        const auto x = samples.latency[i];
+        auto j = i;
+        for (; j > 0 && samples.latency[j - 1] > x; --j) {
+            samples.latency[j] = samples.latency[j - 1];
+        }
+        samples.latency[j] = x;
+    }
+    probe_summary_ty ret;
+    ret.count = samples.count;
+    ret.timeouts = samples.timeouts;
+    ret.p50 = nearest_rank(samples, 50);
+    ret.p90 = nearest_rank(samples, 90);
+    ret.p99 = nearest_rank(samples, 99);
+    ret.max = samples.count == 0 ? 0 : samples.latency[samples.count - 1];
+    return ret;
+}
@@ -0,0 +1,187 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Drives run_probe with a fake clock and scripted pings, and checks the
+// schedule and the statistics derived from it: pings that overrun their slot
+// push the schedule back instead of bunching up, failed pings are counted as
+// timeouts and not as samples, samples past ProbeMaxSamples are dropped, and
+// the nearest-rank percentiles are right for tiny sample counts. Exits
+// nonzero if any check fails.
+
+#include "../src/task-homie/task-homie-probe.hpp"
+
+#include <stdio.h>
+
+static unsigned failures = 0;
+
+static void
+check(const bool ok, const char * const what, const int line) {
+    if (ok) return;
+    printf("FAIL line %d: %s\n", line, what);
+    ++failures;
+}
+
+#define CHECK(x) check((x), #x, __LINE__)
+
+struct fake_clock_ty {
+    uint64_t t;
+
+    uint64_t
+    now() const { return t; }
+
+    void
+    sleep_until(const uint64_t deadline) { if (deadline > t) t = deadline; }
+};
+
+const unsigned MaxPings = 1024;
+
+// Each ping takes latency[i] ticks and fails where ok[i] is false; the start
+// time of every ping is recorded.
+struct pinger_ty {
+    fake_clock_ty &clock;
+    unsigned count;
+    uint64_t latency[MaxPings];
+    bool ok[MaxPings];
+    uint64_t start[MaxPings];
+
+    bool
+    operator()() {
+        const auto i = count++;
+        if (i >= MaxPings) return false;
+        start[i] = clock.t;
+        clock.t += latency[i];
+        return ok[i];
+    }
+};
+
+static fake_clock_ty clock { 0 };
+static pinger_ty pinger { clock, 0, { }, { }, { } };
+static probe_samples_ty hooked;
+static probe_samples_ty unhooked;
+
+static void
+reset_pinger(const uint64_t latency) {
+    pinger.clock.t = 0;
+    pinger.count = 0;
+    for (unsigned i = 0; i < MaxPings; ++i) {
+        pinger.latency[i] = latency;
+        pinger.ok[i] = true;
+        pinger.start[i] = 0;
+    }
+}
+
+static bool
+run(const probe_config_ty &config) {
+    return run_probe(config, pinger.clock, [] { return pinger(); },
+        [] (bool) { return true; }, hooked, unhooked);
+}
+
+static void
+test_overrun() {
+    reset_pinger(3);
+    pinger.latency[1] = 25;
+    CHECK(run(probe_config_ty { 1, 4, 10, 5 }));
+    CHECK(pinger.count == 4);
+    // The second ping runs past the third slot (25); the third fires as soon
+    // as it returns and the fourth keeps the interval from there.
+    CHECK(pinger.start[0] == 5);
+    CHECK(pinger.start[1] == 15);
+    CHECK(pinger.start[2] == 40);
+    CHECK(pinger.start[3] == 50);
+    CHECK(hooked.count == 4 && hooked.latency[1] == 25);
+}
+
+static void
+test_timeouts() {
+    reset_pinger(2);
+    for (unsigned i = 0; i < MaxPings; i += 3) pinger.ok[i] = false;
+    bool phases[3];
+    unsigned nphases = 0;
+    const auto ok = run_probe(probe_config_ty { 3, 6, 10, 0 }, pinger.clock,
+        [] { return pinger(); },
+        [&] (bool on) { phases[nphases++] = on; return true; }, hooked, unhooked);
+    CHECK(ok);
+    CHECK(nphases == 3 && phases[0] && !phases[1] && phases[2]);
+    // Pings 0, 3, ... fail: 2 of every 6 per phase, over two hooked phases.
+    CHECK(hooked.timeouts == 4 && hooked.count == 8);
+    CHECK(unhooked.timeouts == 2 && unhooked.count == 4);
+
+    reset_pinger(2);
+    unsigned calls = 0;
+    const auto failed = run_probe(probe_config_ty { 3, 6, 10, 0 }, pinger.clock,
+        [] { return pinger(); },
+        [&] (bool on) { ++calls; return on; }, hooked, unhooked);
+    CHECK(!failed && calls == 2 && pinger.count == 6);
+}
+
+static void
+test_truncation() {
+    reset_pinger(1);
+    for (unsigned i = 0; i < MaxPings; ++i) pinger.latency[i] = i + 1;
+    CHECK(run(probe_config_ty { 1, ProbeMaxSamples + 100, 1000, 0 }));
+    CHECK(pinger.count == ProbeMaxSamples + 100);
+    CHECK(hooked.count == ProbeMaxSamples && hooked.timeouts == 0);
+    CHECK(hooked.latency[ProbeMaxSamples - 1] == ProbeMaxSamples);
+    const auto summary = summarize_probe(hooked);
+    CHECK(summary.count == ProbeMaxSamples && summary.max == ProbeMaxSamples);
+    CHECK(summary.p50 == 256 && summary.p90 == 461 && summary.p99 == 507);
+}
+
+static probe_summary_ty
+summarize(const unsigned count, const uint64_t * const latency) {
+    probe_samples_ty samples;
+    samples.count = count;
+    samples.timeouts = 0;
+    for (unsigned i = 0; i < count; ++i) samples.latency[i] = latency[i];
+    return summarize_probe(samples);
+}
+
+static void
+test_small_counts() {
+    const auto none = summarize(0, nullptr);
+    CHECK(none.p50 == 0 && none.p90 == 0 && none.p99 == 0 && none.max == 0);
+
+    const uint64_t one_val[] = { 7 };
+    const auto one = summarize(1, one_val);
+    CHECK(one.p50 == 7 && one.p90 == 7 && one.p99 == 7 && one.max == 7);
+
+    const uint64_t two_val[] = { 9, 4 };
+    const auto two = summarize(2, two_val);
+    CHECK(two.p50 == 4 && two.p90 == 9 && two.p99 == 9 && two.max == 9);
+
+    const uint64_t three_val[] = { 30, 10, 20 };
+    const auto three = summarize(3, three_val);
+    CHECK(three.p50 == 20 && three.p90 == 30 && three.p99 == 30 && three.max == 30);
+}
+
+int
+main() {
+    test_overrun();
+    test_timeouts();
+    test_truncation();
+    test_small_counts();
+    printf("probe checks failed: %u\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Replays simulated taskbar animations through the slide estimator and
+// prints, per sequence, when the taskbar would be concealed compared with
+// the plain 4px visibility threshold, and how many conceal decisions were
+// wrong. A conceal is wrong in a sequence that never hides, or at any point
+// after the taskbar has started moving back into view. Exits nonzero if a
+// hide isn't caught early or any conceal is wrong.
+//
+// The hook timestamps samples with GetTickCount, which advances in steps of
+// about 15.6ms, so at 8-12ms frames several samples can share a tick. Every
+// sequence is replayed with exact timestamps and with timestamps rounded
+// down to that tick at two phases. Elapsed times are always reported in
+// real time.
+
+#include "../src/task-homie-hook/task-homie-slide.hpp"
+
+#include <stdio.h>
+
+const int32_t Threshold = 4;
+
+// GetTickCount's default resolution is 1/64s.
+const uint32_t TicksPerSecond = 64;
+
+struct clock_ty { const char *name; bool quantized; uint32_t phase; };
+const unsigned MaxFrames = 64;
+
+struct frame_ty { int32_t exposure; int32_t thickness; uint32_t dt; };
+
+enum kind_ty { Hides, Reverses, Stays };
+
+struct sequence_ty {
+    const char *name;
+    kind_ty kind;
+    unsigned count;
+    frame_ty frames[MaxFrames];
+};
+
+static void
+push(sequence_ty &seq, const int32_t exposure, const uint32_t dt, const int32_t thickness = 48) {
+    if (seq.count < MaxFrames) seq.frames[seq.count++] = frame_ty { exposure, thickness, dt };
+}
+
+// Slides from fully shown to the 2px parked position (or back) in `steps`
+// frames; `ease` makes the steps shrink towards the end like the shell does.
+static sequence_ty
+slide(const char * const name, const bool hide, const int32_t height,
+    const unsigned steps, const uint32_t frame_ms, const bool ease)
+{
+    sequence_ty seq = { name, hide ? Hides : Stays, 0, { } };
+    for (unsigned i = 0; i <= steps; ++i) {
+        const auto t = static_cast<double>(i) / steps;
+        const auto f = ease ? 1 - (1 - t) * (1 - t) : t;
+        const auto shown = static_cast<int32_t>(2 + (height - 2) * (hide ? 1 - f : f) + 0.5);
+        push(seq, shown, i == 0 ? 0 : frame_ms, height);
+    }
+    return seq;
+}
+
+// `instant` counts the conceal decisions made from samples that all share a
+// tick.
+struct result_ty { int conceal_ms; int threshold_ms; unsigned false_positives; unsigned instant; };
+
+static uint32_t
+tick_count(const clock_ty &clock, const uint32_t now) {
+    if (!clock.quantized) return now;
+    const auto t = now + clock.phase;
+    return t * TicksPerSecond / 1000 * 1000 / TicksPerSecond;
+}
+
+static result_ty
+replay(const sequence_ty &seq, const clock_ty &clock) {
+    slide_ty state = { };
+    result_ty ret = { -1, -1, 0, 0 };
+    uint32_t now = 1000;
+    uint32_t start = now;
+    auto turned = false;
+    for (unsigned i = 0; i < seq.count; ++i) {
+        const auto &frame = seq.frames[i];
+        now += frame.dt;
+        if (i == 0) start = now;
+        if (i > 0 && frame.exposure > seq.frames[i - 1].exposure) turned = true;
+        track_slide(state, 1, frame.thickness, frame.exposure, tick_count(clock, now));
+        const auto hiding = hiding_p(state, 1);
+        const auto elapsed = static_cast<int>(now - start);
+        if (frame.exposure <= Threshold && ret.threshold_ms < 0) ret.threshold_ms = elapsed;
+        if (hiding && ret.conceal_ms < 0) ret.conceal_ms = elapsed;
+        if (hiding && (seq.kind == Stays || turned)) ++ret.false_positives;
+        if (hiding && state.time[state.count - 1] == state.time[0]) ++ret.instant;
+    }
+    return ret;
+}
+
+static bool
+report(const sequence_ty * const seqs, const unsigned n, const clock_ty &clock) {
+    unsigned hides = 0;
+    unsigned caught = 0;
+    unsigned false_positives = 0;
+    unsigned instant = 0;
+    int saved_min = -1;
+    int saved_max = 0;
+    int saved_sum = 0;
+    auto ok = true;
+    printf("%-28s %-6s %5s %10s %12s %8s %3s %7s\n", "sequence", "clock",
+        "frame", "conceal_ms", "threshold_ms", "saved_ms", "fp", "instant");
+    for (unsigned i = 0; i < n; ++i) {
+        const auto &seq = seqs[i];
+        const auto res = replay(seq, clock);
+        const auto frame_ms = seq.count > 1 ? static_cast<int>(seq.frames[1].dt) : 0;
+        const auto saved = res.conceal_ms >= 0 && res.threshold_ms >= 0
+            ? res.threshold_ms - res.conceal_ms : 0;
+        printf("%-28s %-6s %5d %10d %12d %8d %3u %7u\n", seq.name, clock.name,
+            frame_ms, res.conceal_ms, res.threshold_ms, saved,
+            res.false_positives, res.instant);
+        false_positives += res.false_positives;
+        instant += res.instant;
+        if (seq.kind == Hides) {
+            ++hides;
+            if (res.conceal_ms >= 0 && saved > 0) ++caught;
+            else ok = false;
+            if (saved_min < 0 || saved < saved_min) saved_min = saved;
+            if (saved > saved_max) saved_max = saved;
+            saved_sum += saved;
+        }
+    }
+    if (false_positives != 0) ok = false;
+    printf("%s: hides caught early: %u/%u, saved ms min/avg/max: %d/%d/%d, "
+        "false positives: %u, instant conceals: %u\n\n", clock.name,
+        caught, hides, saved_min, hides == 0 ? 0 : saved_sum / static_cast<int>(hides),
+        saved_max, false_positives, instant);
+    return ok;
+}
+
+int
+main() {
+    static sequence_ty seqs[32];
+    unsigned n = 0;
+    const uint32_t frame_times[] = { 6, 8, 12, 16 };
+    for (const auto frame_ms : frame_times) {
+        seqs[n++] = slide("hide linear 48px", true, 48, 12, frame_ms, false);
+        seqs[n++] = slide("hide eased 48px", true, 48, 12, frame_ms, true);
+        seqs[n++] = slide("hide eased 30px", true, 30, 8, frame_ms, true);
+        seqs[n++] = slide("show eased 48px", false, 48, 12, frame_ms, true);
+    }
+
+    // WM_MOVEs that pile up while explorer is busy and arrive back to back.
+    auto &burst = seqs[n++];
+    burst = sequence_ty { "hide delivered in a burst", Hides, 0, { } };
+    const int32_t bur[] = { 48, 44, 38, 31, 24, 17, 11, 6, 3, 2 };
+    for (unsigned i = 0; i < sizeof bur / sizeof bur[0]; ++i) {
+        push(burst, bur[i], i == 0 ? 0 : i < 4 ? 40 : 1);
+    }
+
+    auto &nudge = seqs[n++];
+    nudge = sequence_ty { "2px nudge in one tick", Stays, 0, { } };
+    const int32_t nud[] = { 48, 47, 46 };
+    for (const auto e : nud) push(nudge, e, 2);
+
+    auto &reversal = seqs[n++];
+    reversal = sequence_ty { "hide reversed midway", Reverses, 0, { } };
+    const int32_t rev[] = { 48, 44, 40, 36, 32, 36, 40, 44, 48 };
+    for (const auto e : rev) push(reversal, e, 15);
+
+    auto &creep = seqs[n++];
+    creep = sequence_ty { "slow 1px creep", Stays, 0, { } };
+    for (int32_t e = 48; e > 40; --e) push(creep, e, 90);
+
+    auto &jitter = seqs[n++];
+    jitter = sequence_ty { "jitter", Stays, 0, { } };
+    const int32_t jit[] = { 48, 48, 47, 48, 47, 46, 48, 48 };
+    for (const auto e : jit) push(jitter, e, 15);
+
+    auto &resize = seqs[n++];
+    resize = sequence_ty { "resize from the inner edge", Stays, 0, { } };
+    for (int32_t e = 48; e > 24; e -= 4) push(resize, e, 15, e);
+
+    auto &stutter = seqs[n++];
+    stutter = sequence_ty { "retreat with 200ms stalls", Stays, 0, { } };
+    const int32_t stut[] = { 48, 44, 40, 36 };
+    for (const auto e : stut) push(stutter, e, 200);
+
+    const clock_ty clocks[] = {
+        { "exact", false, 0 },
+        { "tick+0", true, 0 },
+        { "tick+8", true, 8 },
+    };
+    auto ok = true;
+    for (const auto &clock : clocks) ok = report(seqs, n, clock) && ok;
+    return ok ? 0 : 1;
+}
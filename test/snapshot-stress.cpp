@@ -0,0 +1,118 @@
+/*
+Copyright (c) 2014, Imran Hameed
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Hammers a snapshot cell the way the hook does: several publisher threads
+// request refreshes and race through refresh() while several readers pin
+// snapshots. The publishers meet at a barrier after every round, where the
+// newest request must either be in the current snapshot or still be pending.
+// Build with -fsanitize=thread (see s/test); exits nonzero if a reader ever
+// sees a torn snapshot or a version older than one it already saw, if a slot
+// is left pinned, or if a refresh request was lost.
+
+#include "../src/task-homie-hook/task-homie-snapshot.hpp"
+
+#include <stdio.h>
+
+#include <thread>
+
+struct sample_ty { unsigned a; unsigned b; unsigned c; };
+
+const unsigned Rounds = 2000;
+const unsigned RoundRequests = 10;
+const unsigned Publishers = 3;
+const unsigned Readers = 4;
+
+static snapshots_ty<sample_ty, 4> snapshots;
+static std::atomic<bool> stale;
+static std::atomic<unsigned> requested;
+
+int
+main() {
+    std::atomic<unsigned> publishers_left(Publishers);
+    std::atomic<unsigned> published(0);
+    std::atomic<unsigned long> reads(0);
+    std::atomic<unsigned long> torn(0);
+    std::atomic<unsigned long> regressed(0);
+    std::atomic<unsigned> lost(0);
+    std::atomic<unsigned> arrived(0);
+    std::atomic<unsigned> generation(0);
+
+    publish(snapshots, [] (sample_ty &x) { x.a = x.b = x.c = 0; });
+
+    // Each snapshot records the newest request it covers.
+    const auto init = [&] (sample_ty &x) {
+        const auto r = requested.load();
+        x.a = r; x.b = r * 2; x.c = r * 3;
+        ++published;
+    };
+
+    std::thread publishers[Publishers];
+    for (auto &publisher : publishers) publisher = std::thread([&] {
+        for (unsigned round = 0; round < Rounds; ++round) {
+            for (unsigned i = 0; i < RoundRequests; ++i) {
+                ++requested;
+                stale.store(true, std::memory_order_release);
+                refresh(snapshots, stale, init);
+            }
+            const auto g = generation.load();
+            if (arrived.fetch_add(1) + 1 != Publishers) {
+                while (generation.load() == g) std::this_thread::yield();
+                continue;
+            }
+            const auto pinned = pin(snapshots);
+            if (!stale && pinned.handle->val.a != requested) ++lost;
+            arrived = 0;
+            ++generation;
+        }
+        --publishers_left;
+    });
+
+    std::thread readers[Readers];
+    for (auto &reader : readers) reader = std::thread([&] {
+        unsigned last = 0;
+        while (publishers_left != 0) {
+            const auto pinned = pin(snapshots);
+            if (pinned.handle == nullptr) continue;
+            const auto &val = pinned.handle->val;
+            if (val.b != val.a * 2 || val.c != val.a * 3) ++torn;
+            if (pinned.handle->version < last) ++regressed;
+            last = pinned.handle->version;
+            ++reads;
+        }
+    });
+
+    for (auto &publisher : publishers) publisher.join();
+    for (auto &reader : readers) reader.join();
+
+    unsigned pinned_left = 0;
+    for (auto &slot : snapshots.slots) pinned_left += slot.readers.load();
+
+    printf("requested=%u published=%u reads=%lu torn=%lu regressed=%lu "
+        "pinned_left=%u lost=%u\n",
+        requested.load(), published.load(), reads.load(), torn.load(),
+        regressed.load(), pinned_left, lost.load());
+    return torn == 0 && regressed == 0 && pinned_left == 0 && lost == 0
+        && published > 0 ? 0 : 1;
+}